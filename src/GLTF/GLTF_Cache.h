@@ -29,18 +29,62 @@
 #define __SOP_GLTFCACHE_H__
 
 #include "GLTF_API.h"
+#include "GLTF_GeoLoader.h"
+#include "GLTF_Util.h"
 
+#include <GU/GU_DetailHandle.h>
+
+#include <UT/UT_Array.h>
 #include <UT/UT_Lock.h>
 #include <UT/UT_Map.h>
 #include <UT/UT_SharedPtr.h>
+#include <UT/UT_StringArray.h>
+#include <UT/UT_TaskLock.h>
+#include <UT/UT_UniquePtr.h>
+
+#include <atomic>
+#include <deque>
+#include <list>
+
+class UT_Condition;
+class UT_Thread;
 
 namespace GLTF_NAMESPACE
 {
 
 class GLTF_Loader;
 
+enum GLTF_CacheValidation
+{
+    // Cached loaders are used until they are evicted
+    GLTF_CACHE_VALIDATE_NONE,
+    // Cached loaders are reloaded when the size, modification time or
+    // inode of any of their files changes
+    GLTF_CACHE_VALIDATE_STAT,
+    // As above, but also compares a hash of the ends of each file
+    GLTF_CACHE_VALIDATE_HASH
+};
+
+enum GLTF_PrefetchContents
+{
+    // Only parse the JSON of each file
+    GLTF_PREFETCH_JSON,
+    // Also read in all of the buffer data of each file
+    GLTF_PREFETCH_BUFFERS
+};
+
+///
+/// A singleton responsible for storing a cached GLTF_Loader.  Once more
+/// loaders are cached than the file limit allows, or the cached loaders hold
+/// more memory than the memory limit allows, the least recently used loaders
+/// are evicted.
 ///
-/// A singleton responsible for storing a cached GLTF_Loader.
+/// Each loader is checked against the files it was loaded from whenever it
+/// is requested, and is transparently reloaded if any of them has changed.
+///
+/// Files are loaded without holding the cache lock, so requests for other
+/// files are never held up by a load.  Concurrent requests for a file which
+/// is being loaded wait for that load rather than starting their own.
 ///
 class GLTF_API GLTF_Cache
 {
@@ -50,23 +94,227 @@ public:
     ///
     /// Creates a new loader with the given filepath, calls Load()
     /// and returns a pointer.  If we were unable to load, then
-    /// the loader is evicted and null is returned
+    /// the loader is evicted and null is returned.  If cancel is given and
+    /// becomes true, a load started by this call is abandoned, and any other
+    /// requests waiting on it start their own.
     ///
-    const UT_SharedPtr<const GLTF_Loader> LoadLoader(const UT_StringHolder &path);
+    const UT_SharedPtr<const GLTF_Loader> LoadLoader(
+        const UT_StringHolder &path,
+        const std::atomic<bool> *cancel = nullptr);
 
     // Removes the loader from the cache, does not destroy any existing
     // instances as loaders are UT_SharedPtr's
     bool EvictLoader(const UT_StringHolder &path);
 
+    ///
+    /// Sets the maximum number of cached loaders and the maximum number of
+    /// bytes they may hold, evicting loaders as required.  A memory limit
+    /// of zero disables the memory limit.  The defaults may be set with the
+    /// HOUDINI_GLTF_CACHE_MAX_FILES and HOUDINI_GLTF_CACHE_MAX_MB
+    /// environment variables.
+    ///
+    void SetLimits(exint max_files, int64 max_memory);
+    void GetLimits(exint &max_files, int64 &max_memory) const;
+
+    ///
+    /// Returns the given primitive of a loader converted to geometry by
+    /// GLTF_GeoLoader.  The conversions of loaders held by the cache are
+    /// cached along with the loader and count towards its memory limit.  The
+    /// returned detail may be shared, so must not be modified.
+    /// @return An invalid handle if the primitive couldn't be loaded
+    ///
+    GU_DetailHandle LoadPrimitive(const GLTF_Loader &loader,
+                                  GLTF_Handle mesh_idx, GLTF_Handle prim_idx,
+                                  const GLTF_MeshLoadingOptions &options);
+
+    // Returns the number of bytes held by all cached loaders and the
+    // geometry converted from them
+    int64 GetMemoryUsage() const;
+
+    ///
+    /// Sets how cached loaders are checked for changes to their files.  The
+    /// default may be set with the HOUDINI_GLTF_CACHE_VALIDATE environment
+    /// variable, as one of "none", "stat" or "hash".
+    ///
+    void SetValidation(GLTF_CacheValidation validation);
+
+    ///
+    /// Queues the given files to be loaded into the cache by a pool of
+    /// background threads, so that later requests find them ready.  The
+    /// pool has 4 threads unless HOUDINI_GLTF_PREFETCH_THREADS says
+    /// otherwise.
+    /// @return An id for following the progress of the prefetch
+    ///
+    exint Prefetch(const UT_StringArray &paths, GLTF_PrefetchContents what);
+
+    ///
+    /// Returns the number of files of a prefetch which have been dealt with,
+    /// whether they loaded, failed or were cancelled, and the total number
+    /// of files.  Once a finished prefetch has been reported, its id is
+    /// forgotten.
+    /// @return Whether or not the prefetch id is known
+    ///
+    bool GetPrefetchProgress(exint id, exint &done, exint &total);
+
+    // Skips the files of the prefetch which haven't finished loading, and
+    // forgets its id.  Files which are being loaded are abandoned between
+    // the elements of their JSON arrays or between their buffers.
+    void CancelPrefetch(exint id);
+
+    ///
+    /// Stops the prefetch threads, cancelling the files they are loading
+    /// and skipping the rest.  Later prefetches are ignored.  This is
+    /// called on exit, before static destructors run.
+    ///
+    void ShutdownPrefetch();
+
 private:
+    GLTF_Cache();
+    ~GLTF_Cache();
+
+    struct PrefetchState
+    {
+        GLTF_PrefetchContents myContents;
+        exint myTotal = 0;
+        std::atomic<exint> myDone{0};
+        std::atomic<bool> myCancelled{false};
+    };
+
+    struct PrefetchJob
+    {
+        UT_StringHolder myPath;
+        UT_SharedPtr<PrefetchState> myState;
+    };
+
+    // Runs queued prefetch jobs until the prefetch threads are shut down
+    static void *PrefetchWorker(void *data);
+    static void ShutdownPrefetchCallback(void *data);
+
+    // Identifies a primitive converted with a set of options
+    struct DetailKey
+    {
+        GLTF_Handle myMesh;
+        GLTF_Handle myPrim;
+        GLTF_MeshLoadingOptions myOptions;
+
+        bool operator==(const DetailKey &other) const
+        {
+            return myMesh == other.myMesh && myPrim == other.myPrim &&
+                   myOptions == other.myOptions;
+        }
+    };
+
+    struct DetailKeyHasher
+    {
+        size_t operator()(const DetailKey &key) const
+        {
+            size_t h = key.myOptions.hash();
+            SYShashCombine(h, key.myMesh);
+            SYShashCombine(h, key.myPrim);
+            return h;
+        }
+    };
+
+    struct CachedDetail
+    {
+        GU_DetailHandle myDetail;
+        int64 myMemory = 0;
+    };
+
+    // The paths of the cached loaders, from least to most recently used
+    typedef std::list<UT_StringHolder> UseList;
+
+    struct Entry
+    {
+        UT_SharedPtr<const GLTF_Loader> myLoader;
+        // The position of the entry's path in myUseOrder
+        UseList::iterator myUsePos;
+        // The files the loader was loaded from, as they were before loading
+        UT_StringArray myFiles;
+        UT_Array<GLTF_FileIdentity> myFileIdentities;
+        // The primitives converted from the loader
+        UT_Map<DetailKey, CachedDetail, DetailKeyHasher> myDetails;
+        int64 myDetailMemory = 0;
+        // The memory of the parsed structures of the loader, which is
+        // measured once after loading
+        int64 myTableMemory = 0;
+        // The memory of the entry which is included in myMemoryUsage
+        int64 myCountedMemory = 0;
+    };
+
+    typedef UT_Map<UT_StringHolder, Entry> EntryMap;
+
+    // A load which is in progress, which other requests for the same path
+    // wait on.  myLock is held by the loading thread until myLoader is set.
+    // Requests which find that the load was cancelled retry it themselves.
+    struct InFlightLoad
+    {
+        UT_TaskLock myLock;
+        UT_SharedPtr<const GLTF_Loader> myLoader;
+        bool myCancelled = false;
+    };
+
+    // Returns whether any of the files have changed from their identities.
+    // This may read the files, so is called without holding the lock.
+    static bool IsStale(const UT_StringArray &files,
+                        const UT_Array<GLTF_FileIdentity> &identities,
+                        GLTF_CacheValidation validation);
+
+    // Returns the number of bytes held by the entry, from the sizes which
+    // are counted as its data is loaded
+    static int64 GetEntryMemoryUsage(const Entry &entry);
+
+    // Returns the entry holding the given loader, or the end of the map
+    EntryMap::iterator FindLoaderEntry(const GLTF_Loader &loader);
+
+    // Adds a loaded entry to the cache as the most recently used
+    void InsertEntry(const UT_StringHolder &path, Entry &&entry);
+
+    // Removes an entry from the cache, along with its memory and use
+    void EraseEntry(EntryMap::iterator it);
+
+    // Marks the entry as the most recently used
+    void TouchEntry(Entry &entry);
+
+    // Adds any memory the entry has gained since it was last counted to
+    // myMemoryUsage.  Loaders load their data lazily, so this is called
+    // whenever an entry is used.
+    void CountEntryMemory(Entry &entry);
+
+    // Loads the file at path into entry, without holding the cache lock
+    static bool LoadEntry(const UT_StringHolder &path,
+                          GLTF_CacheValidation validation,
+                          const std::atomic<bool> *cancel, Entry &entry);
+
     // Gets an existing loader from the cache, returns false
     // if the loader does not exist
     const UT_SharedPtr<const GLTF_Loader> GetLoader(const UT_StringHolder &path);
 
+    // Evicts the least recently used loaders other than the one at
+    // keep_path until the cache is within its limits.  This is only called
+    // when something is added to the cache or the limits change.
+    void AutomaticEvict(const UT_StringHolder &keep_path);
 
-    void AutomaticEvict();
+    EntryMap myLoaderMap;
+    UT_Map<const GLTF_Loader *, UT_StringHolder> myLoaderPaths;
+    UseList myUseOrder;
+    // The sum of myCountedMemory over the entries
+    int64 myMemoryUsage = 0;
+    UT_Map<UT_StringHolder, UT_SharedPtr<InFlightLoad>> myInFlightLoads;
+    exint myMaxFiles;
+    int64 myMaxMemory;
+    GLTF_CacheValidation myValidation;
 
-    UT_Map<UT_StringHolder, UT_SharedPtr<const GLTF_Loader>> myLoaderMap;
+    // The prefetch thread pool, which is started on first use.  Idle
+    // threads wait on myPrefetchCondition.
+    UT_Lock myPrefetchLock;
+    UT_UniquePtr<UT_Condition> myPrefetchCondition;
+    std::deque<PrefetchJob> myPrefetchQueue;
+    UT_Array<UT_Thread *> myPrefetchThreads;
+    UT_Map<exint, UT_SharedPtr<PrefetchState>> myPrefetches;
+    exint myNextPrefetchId = 0;
+    exint myMaxPrefetchThreads;
+    bool myPrefetchShutdown = false;
 };
 
 } // end GLTF_NAMESPACE
@@ -32,12 +32,18 @@
 
 #include <GLTF/GLTF_Types.h>
 
+#include <GA/GA_Types.h>
+#include <SYS/SYS_Hash.h>
+
 #include <UT/UT_Array.h>
 #include <UT/UT_Quaternion.h>
 #include <UT/UT_StringHolder.h>
 #include <UT/UT_Vector3.h>
 
+#include <functional>
+
 // Forward declarations
+class GEO_PolyCounts;
 class GU_Detail;
 class UT_String;
 
@@ -46,12 +52,48 @@ namespace GLTF_NAMESPACE
 
 class GLTF_Loader;
 
+// How points are merged after promoting their attributes to vertices
+enum GLTF_PointWeldMode
+{
+    // Merge points within pointConsolidationDistance of each other
+    GLTF_POINT_WELD_DISTANCE,
+    // Merge points at exactly the same position, building the vertex
+    // attributes directly
+    GLTF_POINT_WELD_POSITION
+};
+
 struct GLTF_API GLTF_MeshLoadingOptions
 {
     bool loadCustomAttribs = true;
     bool promotePointAttribs = true;
     bool consolidatePoints = true;
     fpreal pointConsolidationDistance = 0.0001F;
+    GLTF_PointWeldMode pointWeldMode = GLTF_POINT_WELD_DISTANCE;
+    // Stores attributes at the precision of their source data where
+    // possible instead of always using 32 bit floats and ints
+    bool compactStorage = false;
+
+    bool operator==(const GLTF_MeshLoadingOptions &other) const
+    {
+        return loadCustomAttribs == other.loadCustomAttribs &&
+               promotePointAttribs == other.promotePointAttribs &&
+               consolidatePoints == other.consolidatePoints &&
+               pointConsolidationDistance == other.pointConsolidationDistance &&
+               pointWeldMode == other.pointWeldMode &&
+               compactStorage == other.compactStorage;
+    }
+
+    // Hashes every option, for caching converted geometry
+    size_t hash() const
+    {
+        size_t h = SYShash(loadCustomAttribs);
+        SYShashCombine(h, promotePointAttribs);
+        SYShashCombine(h, consolidatePoints);
+        SYShashCombine(h, pointConsolidationDistance);
+        SYShashCombine(h, int(pointWeldMode));
+        SYShashCombine(h, compactStorage);
+        return h;
+    }
 };
 
 class GLTF_API GLTF_GeoLoader
@@ -67,18 +109,51 @@ public:
                      GLTF_Handle primitive_idx, GU_Detail &detail,
                      const GLTF_MeshLoadingOptions options = {});
 
+    // Merges all points of the detail which are at exactly the same position
+    static void weldPointsByPosition(GU_Detail &detail);
+
 private:
+    // Decodes and validates the index accessor into position elements,
+    // optionally reversing the winding of each triangle as it goes
+    bool
+    DecodeIndices(const GLTF_Accessor &pos, const GLTF_Accessor &ind,
+                  bool reverse_triangles, UT_Array<int> &elements);
+
+    // Creates the primitives of any mode other than points, filling
+    // vertex_elements with the position element of each vertex
+    bool
+    LoadVerticesAndPoints(GU_Detail &detail, GLTF_RenderMode mode,
+                          const GLTF_Accessor &pos, const GLTF_Accessor *ind,
+                          UT_Array<int> &vertex_elements,
+                          GA_Offset &start_pt_off, GA_Offset &start_vtx_off);
+
+    bool
+    BuildPolygons(GU_Detail &detail, const GLTF_Accessor &pos,
+                  const UT_Array<int> &vertex_elements,
+                  const GEO_PolyCounts &counts, bool closed,
+                  GA_Offset &start_pt_off, GA_Offset &start_vtx_off);
+
+    // Creates just the points of a primitive in points mode
     bool
-    LoadVerticesAndPoints(GU_Detail &detail,
-                          const GLTF_MeshLoadingOptions &options,
-                          const GLTF_Accessor &pos, const GLTF_Accessor &ind);
+    LoadPointCloud(GU_Detail &detail, const GLTF_Primitive &primitive,
+                   const GLTF_Accessor &pos, const GLTF_Accessor *ind);
 
+    // Loads every attribute other than the position into the num_elems
+    // elements starting at start_off
     bool
-    LoadVerticesAndPointsNonIndexed(GU_Detail &detail, const GLTF_Accessor &pos);
+    LoadAttributes(GU_Detail &detail, const GLTF_Primitive &primitive,
+                   const GLTF_Accessor &position, GA_AttributeOwner owner,
+                   GA_Offset start_off, GA_Size num_elems, const int *gather);
 
+    // Creates the attribute and appends a task to fills which fills the
+    // num_elems elements starting at start_off from the accessor, either in
+    // order or gathered through the given elements
     bool
-    AddPointAttribute(GU_Detail &detail, const UT_StringHolder &attrib_name,
-                      const GLTF_Accessor &accessor);
+    AddAttribute(GU_Detail &detail, GA_AttributeOwner owner,
+                 const UT_StringHolder &attrib_name,
+                 const GLTF_Accessor &accessor, GA_Offset start_off,
+                 GA_Size num_elems, const int *gather,
+                 UT_Array<std::function<bool()>> &fills);
 
     // const uint32 myRootNode;
     const GLTF_Handle myMeshIdx;
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) COPYRIGHTYEAR
+ *       Side Effects Software Inc.  All rights reserved.
+ *
+ * Redistribution and use of Houdini Development Kit samples in source and
+ * binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. The name of Side Effects Software may not be used to endorse or
+ *    promote products derived from this software without specific prior
+ *    written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE `AS IS' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+ * NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef __SOP_GLTFINDEXCACHE_H__
+#define __SOP_GLTFINDEXCACHE_H__
+
+#include "GLTF_API.h"
+
+#include <UT/UT_StringHolder.h>
+
+namespace GLTF_NAMESPACE
+{
+
+class GLTF_Loader;
+
+///
+/// Stores the tables parsed from a .gltf file in a compact binary sidecar,
+/// so that reopening an unchanged file doesn't need to parse its JSON.
+/// Sidecars are keyed by the source path, size, modification time and a
+/// hash of the file contents, and are written beside the source file unless
+/// a cache directory is given.
+///
+class GLTF_API GLTF_IndexCache
+{
+public:
+    ///
+    /// Fills the empty loader with the tables stored in the sidecar for
+    /// filename.  The loader is left untouched on failure.
+    /// @return Whether or not an up to date sidecar was read
+    ///
+    static bool read(const UT_StringRef &filename,
+                     const UT_StringRef &cache_dir, GLTF_Loader &loader);
+
+    ///
+    /// Writes the tables of the loaded loader to the sidecar for filename,
+    /// replacing any existing sidecar.
+    /// @return Whether or not the sidecar was written
+    ///
+    static bool write(const UT_StringRef &filename,
+                      const UT_StringRef &cache_dir, const GLTF_Loader &loader);
+};
+
+} // end GLTF_NAMESPACE
+
+#endif
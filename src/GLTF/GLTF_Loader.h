@@ -33,8 +33,15 @@
 
 #include <UT/UT_Array.h>
 #include <UT/UT_String.h>
+#include <UT/UT_StringArray.h>
+#include <UT/UT_StringHolder.h>
 #include <UT/UT_Lock.h>
+#include <UT/UT_Map.h>
+#include <UT/UT_UniquePtr.h>
 
+#include <atomic>
+
+class UT_JSONParser;
 class UT_JSONValue;
 class UT_JSONValueMap;
 class UT_JSONValueArray;
@@ -42,6 +49,53 @@ class UT_JSONValueArray;
 namespace GLTF_NAMESPACE
 {
 
+class GLTF_MappedFile;
+class GLTF_RandomAccessFile;
+
+//=================================================
+
+enum GLTF_BufferLoadMode
+{
+    // Read each external buffer into memory in its entirety
+    GLTF_BUFFER_LOAD_READ,
+    // Memory map each external buffer, falling back to reading it
+    // if the file can not be mapped.  The mapped files must not be
+    // modified while the loader exists: rewriting one changes the loaded
+    // data, and truncating one crashes with SIGBUS on the next access.
+    GLTF_BUFFER_LOAD_MAP,
+    // Read only the byte range of each external bufferView that is
+    // accessed, caching the result per bufferView
+    GLTF_BUFFER_LOAD_RANGE
+};
+
+enum GLTF_JSONParseMode
+{
+    // Stream the JSON, reading each item straight from the parser's
+    // tokens without building a tree
+    GLTF_JSON_PARSE_STREAM,
+    // Parse the JSON into a complete UT_JSONValue tree before reading it
+    GLTF_JSON_PARSE_DOM
+};
+
+struct GLTF_API GLTF_LoaderOptions
+{
+    // Mapping and range reads are opt-in, as they keep reading from the
+    // files after loading
+    GLTF_BufferLoadMode bufferLoadMode = GLTF_BUFFER_LOAD_READ;
+    GLTF_JSONParseMode jsonParseMode = GLTF_JSON_PARSE_STREAM;
+    // Whether the tables parsed from .gltf files are stored in and read
+    // from a binary sidecar (see GLTF_IndexCache)
+    bool useIndexCache = false;
+    // The directory holding sidecars, or empty to write them beside the
+    // source files
+    UT_StringHolder indexCacheDir;
+    // Whether external buffers are checked against the files as they were
+    // when loading, so that a loader never mixes data from different
+    // versions of its files.  Buffers whose files have changed fail to load.
+    // Mapped buffers can't be checked once they are mapped.
+    bool checkBufferFiles = false;
+};
+
 //=================================================
 
 ///
@@ -51,7 +105,8 @@ class GLTF_API GLTF_Loader
 {
 public:
     GLTF_Loader();
-    GLTF_Loader(UT_String filename);
+    GLTF_Loader(UT_String filename,
+                const GLTF_LoaderOptions &options = GLTF_LoaderOptions());
     virtual ~GLTF_Loader();
 
     // Delete copy constructor
@@ -60,19 +115,42 @@ public:
 
     ///
     /// Loads and parses the JSON data within this GLTF file.
-    /// Does not load any associated buffer data.
+    /// Does not load any associated buffer data.  If cancel is given, the
+    /// load gives up once it becomes true, checking between the elements of
+    /// the JSON arrays.
     /// @return Whether or not the load suceeded
     ///
-    bool Load();
+    bool Load(const std::atomic<bool> *cancel = nullptr);
 
     ///
     /// Loads all data that can be accessed with the given accessor and returns
     /// a pointer to the beginning of the data.  The caller is not responsible
-    /// for deleting the returned data.
+    /// for deleting the returned data, and must not write to it as it may
+    /// point directly into a memory mapped file.  Sparse accessors, and
+    /// accessors without a bufferView, are expanded into tightly packed data
+    /// the first time they are loaded.
     /// @return Whether or not the accessor data load suceeded
     ///
     bool LoadAccessorData(const GLTF_Accessor &accessor, unsigned char *&data) const;
 
+    ///
+    /// As above, but also returns the distance in bytes between consecutive
+    /// elements and checks that every element lies within the bufferView.
+    /// The stride must be used rather than the bufferView's byteStride, as
+    /// expanded accessor data is always tightly packed.
+    ///
+    bool LoadAccessorData(const GLTF_Accessor &accessor, unsigned char *&data,
+                          uint32 &stride) const;
+
+    ///
+    /// Loads the data of every bufferView up front, reading in any memory
+    /// mapped pages, so that later accessor loads don't wait on the disk.
+    /// If cancel is given, this stops once it becomes true, checking between
+    /// bufferViews and every megabyte of pages.
+    /// @return Whether or not all of the data was loaded
+    ///
+    bool LoadAllBufferData(const std::atomic<bool> *cancel = nullptr) const;
+
     GLTF_Accessor *createAccessor(GLTF_Handle& idx);
     GLTF_Animation *createAnimation(GLTF_Handle& idx);
     GLTF_Buffer *createBuffer(GLTF_Handle& idx);
@@ -151,22 +229,65 @@ public:
     exint getNumSkins() const;
     exint getNumTextures() const;
 
+    // Returns the path the loader was created with
+    const UT_String &getFilename() const { return myFilename; }
+
+    ///
+    /// Returns the paths of the files the loader reads from: the file
+    /// itself, followed by every external buffer.
+    ///
+    void getSourceFiles(UT_StringArray &paths) const;
+
+    ///
+    /// Returns the number of bytes held by the loader: its parsed structures
+    /// and all buffer data loaded so far, whether read or memory mapped.
+    ///
+    int64 getMemoryUsage(bool inclusive) const;
+
+    // Returns the number of bytes held by the parsed structures, which
+    // doesn't change once the loader is loaded
+    int64 getTableMemoryUsage(bool inclusive) const;
+
+    // Returns the number of bytes of buffer data loaded so far.  This is
+    // counted as the data is loaded, so is cheap to call.
+    int64 getDataMemoryUsage() const
+    {
+        return myDataMemory.load(std::memory_order_relaxed);
+    }
+
 private:
     // Handles reading the JSON map, which may be external or
     // embedded in a GLB file
+    bool ParseJSON(UT_JSONParser &parser);
     bool ReadJSON(const UT_JSONValueMap &root_json);
 
+    // Reads the JSON map as it is parsed, filling in each item straight
+    // from the parser without building any UT_JSONValue
+    bool StreamJSON(UT_JSONParser &parser);
+
+    // Checks indices between top level arrays once all have been read
+    bool ValidateReferences() const;
+
+    // Discards everything read from the JSON or an index sidecar
+    void ClearTables();
+
+    // Returns whether the file of the given external buffer is the same as
+    // when the loader was loaded, or true if files aren't being checked
+    bool IsBufferFileUnchanged(uint32 idx, const char *path) const;
+
     bool ReadGLTF();
     bool ReadGLB();
 
     bool ReadAsset(const UT_JSONValueMap &asset_json);
 
-    // Read items from GLTF JSON -> GLTF struct
+    // Read items from GLTF JSON -> GLTF struct.  Each writes only the item
+    // at idx of its presized array, so they may be called concurrently.
     bool ReadNode(const UT_JSONValueMap &node_json, const exint idx);
     bool ReadBuffer(const UT_JSONValueMap &buffer_json, const exint idx);
     bool ReadBufferView(const UT_JSONValueMap &bufferview_json, const exint idx);
     bool ReadAccessor(const UT_JSONValueMap &accessor_json, const exint idx);
     bool ReadPrimitive(const UT_JSONValue *primitive_json, GLTF_Primitive *primitive);
+    bool ReadSparse(const UT_JSONValue *sparse_json, GLTF_Sparse *sparse);
     bool ReadMesh(const UT_JSONValueMap &mesh_json, const exint idx);
     bool ReadTexture(const UT_JSONValueMap &texture_json, const exint idx);
     bool ReadSampler(const UT_JSONValueMap &sampler_json, const exint idx);
@@ -174,18 +295,37 @@ private:
     bool ReadScene(const UT_JSONValueMap &scene_json, const exint idx);
     bool ReadMaterial(const UT_JSONValueMap &material_json, const exint idx);
 
-    // Utility:  Takes an array of maps, and calls funcs() on every item
-    bool ReadArrayOfMaps(const UT_JSONValue *arr, bool required,
-                         std::function<bool(const UT_JSONValueMap &, const exint idx)> func);
-
     UT_String myFilename;
     UT_String myBasePath;
+    GLTF_LoaderOptions myOptions;
 
     bool myIsLoaded;
 
+    // The cancel flag passed to Load(), which is only set while loading
+    const std::atomic<bool> *myCancel = nullptr;
+    bool IsCancelled() const
+    {
+        return myCancel && myCancel->load(std::memory_order_relaxed);
+    }
+
     // Retrieves the buffer at idx, potentially from cache if cached.
     bool LoadBuffer(uint32 idx, unsigned char *&buffer_data) const;
 
+    // Retrieves the data of the bufferView at idx.  In range loading mode
+    // only the bufferView's bytes are read from external buffers.
+    bool LoadBufferView(uint32 idx, unsigned char *&bufferview_data) const;
+
+    // Retrieves the elements of an accessor stored in a bufferView, checking
+    // that they all lie within it
+    bool LoadBufferViewAccessorData(const GLTF_Accessor &accessor,
+                                    unsigned char *&data,
+                                    uint32 &stride) const;
+
+    // Builds the tightly packed contents of an accessor which is sparse or
+    // has no bufferView.  The result is cached for the life of the loader.
+    bool MaterializeAccessor(const GLTF_Accessor &accessor,
+                             unsigned char *&data) const;
+
     // Simply an indexed array of pointers to buffer data
     UT_Array<GLTF_Accessor *> myAccesors;
     UT_Array<GLTF_Animation *> myAnimations;
@@ -203,10 +343,53 @@ private:
     UT_Array<GLTF_Skin *> mySkins;
     UT_Array<GLTF_Texture *> myTextures;
 
+    // Data which is loaded on first access.  Once loaded the pointer is
+    // published atomically, so resident data is read without locking and
+    // only threads loading the same slot wait on each other.
+    struct LazyData
+    {
+        std::atomic<unsigned char *> myData{nullptr};
+        UT_Lock myLock;
+    };
+
+    // Returns the external file backing buffer idx for range reads,
+    // opening it if required
+    GLTF_RandomAccessFile *OpenBufferFile(uint32 idx) const;
+
     // Loading is transparent to the caller -- we want const 
     // semantics that 
-    mutable UT_Lock myAccessorLock;
-    mutable UT_Array<unsigned char *> myBufferCache;
+    mutable UT_UniquePtr<LazyData[]> myBufferCache;
+    exint myNumCachedBuffers = 0;
+    // The mapping backing each entry of myBufferCache, or nullptr if the
+    // entry was allocated with malloc()
+    mutable UT_Array<GLTF_MappedFile *> myBufferMaps;
+    // Used in range loading mode: the open external file backing each
+    // buffer and the data read in for each bufferView
+    mutable UT_Array<GLTF_RandomAccessFile *> myBufferFiles;
+    mutable UT_UniquePtr<LazyData[]> myBufferViewCache;
+    exint myNumCachedBufferViews = 0;
+
+    // The dense data of accessors built by MaterializeAccessor().  The
+    // lock only guards finding or adding a slot, and each accessor is built
+    // under the lock of its own slot.
+    mutable UT_Map<const GLTF_Accessor *, UT_UniquePtr<LazyData>>
+        myMaterializedAccessors;
+    mutable UT_Lock myMaterializedLock;
+
+    // The contents of a GLB file, either mapped or read in whole
+    UT_UniquePtr<GLTF_MappedFile> myGLBFile;
+    unsigned char *myGLBData = nullptr;
+    // The BIN chunk within the GLB file contents, which is referenced in
+    // place by myBufferCache rather than copied
+    unsigned char *myGLBBuffer = nullptr;
+    exint myGLBBufferSize = 0;
+
+    // The bytes of all buffer data published so far
+    mutable std::atomic<int64> myDataMemory{0};
+
+    // The identities of the external buffer files when loading, if
+    // checkBufferFiles is set
+    UT_Array<GLTF_FileIdentity> myBufferIdentities;
 };
 
 //=================================================
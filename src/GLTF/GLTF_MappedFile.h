@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) COPYRIGHTYEAR
+ *       Side Effects Software Inc.  All rights reserved.
+ *
+ * Redistribution and use of Houdini Development Kit samples in source and
+ * binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. The name of Side Effects Software may not be used to endorse or
+ *    promote products derived from this software without specific prior
+ *    written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE `AS IS' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+ * NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef __SOP_GLTFMAPPEDFILE_H__
+#define __SOP_GLTFMAPPEDFILE_H__
+
+#include "GLTF_API.h"
+
+#include <SYS/SYS_Types.h>
+
+namespace GLTF_NAMESPACE
+{
+
+///
+/// A read-only memory mapping of a file on disk.  Pages are only faulted in
+/// when they are touched, and are shared with any other process mapping the
+/// same file.
+///
+/// Writes to the file by other processes show through the mapping, and
+/// accessing a page past the end of a file which has since been truncated
+/// raises SIGBUS.  Only map files which won't change while mapped.
+///
+class GLTF_API GLTF_MappedFile
+{
+public:
+    GLTF_MappedFile();
+    ~GLTF_MappedFile();
+
+    GLTF_MappedFile(const GLTF_MappedFile &) = delete;
+    GLTF_MappedFile &operator=(const GLTF_MappedFile &) = delete;
+
+    ///
+    /// Maps the entire file into memory, unmapping any previously
+    /// mapped file.  Empty files can not be mapped.
+    /// @return Whether or not the mapping suceeded
+    ///
+    bool open(const char *filename);
+    void close();
+
+    bool isOpen() const { return myData != nullptr; }
+
+    const unsigned char *data() const { return myData; }
+    exint size() const { return mySize; }
+
+private:
+    unsigned char *myData;
+    exint mySize;
+#if defined(WIN32)
+    void *myFileHandle;
+    void *myMapHandle;
+#endif
+};
+
+} // end GLTF_NAMESPACE
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) COPYRIGHTYEAR
+ *       Side Effects Software Inc.  All rights reserved.
+ *
+ * Redistribution and use of Houdini Development Kit samples in source and
+ * binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. The name of Side Effects Software may not be used to endorse or
+ *    promote products derived from this software without specific prior
+ *    written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE `AS IS' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+ * NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef __SOP_GLTFPACKEDMESH_H__
+#define __SOP_GLTFPACKEDMESH_H__
+
+#include "GLTF_API.h"
+#include "GLTF_GeoLoader.h"
+
+#include <GA/GA_Types.h>
+#include <GU/GU_DetailHandle.h>
+#include <GU/GU_PackedImpl.h>
+#include <UT/UT_BoundingBox.h>
+#include <UT/UT_Lock.h>
+#include <UT/UT_StringHolder.h>
+
+class GA_PrimitiveFactory;
+class GU_PrimPacked;
+
+namespace GLTF_NAMESPACE
+{
+
+///
+/// A packed primitive referencing a single primitive of a mesh in a glTF
+/// file.  Only the file, the mesh, the primitive and the loading options are
+/// stored, and the geometry is loaded through GLTF_Cache the first time it
+/// is needed.  The bounds come from the min and max of the POSITION
+/// accessor, so they are known without loading anything.
+///
+class GLTF_API GLTF_PackedMesh : public GU_PackedImpl
+{
+public:
+    GLTF_PackedMesh();
+    GLTF_PackedMesh(const GLTF_PackedMesh &src);
+    virtual ~GLTF_PackedMesh() override;
+
+    ///
+    /// Registers the packed primitive type under the given name.  This must
+    /// be called from the newGeometryPrim() hook of a DSO before build() can
+    /// be used.
+    ///
+    static void install(GA_PrimitiveFactory *factory, const char *name,
+                        const char *label);
+
+    // Returns whether or not install() has succeeded
+    static bool isInstalled();
+
+    ///
+    /// Appends a packed primitive for the given primitive of the loader.
+    /// @return The new primitive, or nullptr if the type isn't installed
+    ///
+    static GU_PrimPacked *build(GU_Detail &gdp, const GLTF_Loader &loader,
+                                GLTF_Handle mesh_idx, GLTF_Handle prim_idx,
+                                const GLTF_MeshLoadingOptions &options);
+
+    virtual GU_PackedFactory *getFactory() const override;
+    virtual GU_PackedImpl *copy() const override;
+    virtual void clearData() override;
+
+    virtual bool isValid() const override;
+    virtual bool isLoaded() const override;
+
+    virtual bool load(GU_PrimPacked *prim, const UT_Options &options,
+                      const GA_LoadMap &map) override;
+    virtual void
+    update(GU_PrimPacked *prim, const UT_Options &options) override;
+    virtual bool
+    save(UT_Options &options, const GA_SaveMap &map) const override;
+
+    virtual bool getBounds(UT_BoundingBox &box) const override;
+    virtual bool getRenderingBounds(UT_BoundingBox &box) const override;
+    virtual void
+    getVelocityRange(UT_Vector3 &min, UT_Vector3 &max) const override;
+    virtual void getWidthRange(fpreal &min, fpreal &max) const override;
+
+    virtual bool unpack(GU_Detail &destgdp,
+                        const UT_Matrix4D *transform) const override;
+    virtual GU_ConstDetailHandle
+    getPackedDetail(GU_PackedContext *context = 0) const override;
+
+    virtual int64 getMemoryUsage(bool inclusive) const override;
+    virtual void
+    countMemory(UT_MemoryCounter &counter, bool inclusive) const override;
+
+private:
+    // Loads the geometry if it hasn't been already
+    GU_ConstDetailHandle loadDetail() const;
+
+    UT_StringHolder myFilename;
+    GLTF_Handle myMeshIdx;
+    GLTF_Handle myPrimIdx;
+    GLTF_MeshLoadingOptions myOptions;
+
+    // Taken from the POSITION accessor when it has a min and max, and
+    // otherwise computed from the geometry once it's loaded
+    mutable UT_BoundingBox myBounds;
+    mutable bool myHasBounds;
+
+    mutable UT_Lock myLock;
+    mutable GU_DetailHandle myDetail;
+};
+
+} // end GLTF_NAMESPACE
+
+#endif
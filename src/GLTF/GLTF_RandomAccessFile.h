@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) COPYRIGHTYEAR
+ *       Side Effects Software Inc.  All rights reserved.
+ *
+ * Redistribution and use of Houdini Development Kit samples in source and
+ * binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. The name of Side Effects Software may not be used to endorse or
+ *    promote products derived from this software without specific prior
+ *    written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE `AS IS' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+ * NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *----------------------------------------------------------------------------
+ */
+
+#ifndef __SOP_GLTFRANDOMACCESSFILE_H__
+#define __SOP_GLTFRANDOMACCESSFILE_H__
+
+#include "GLTF_API.h"
+
+#include <SYS/SYS_Types.h>
+
+namespace GLTF_NAMESPACE
+{
+
+///
+/// A read-only file handle supporting positional reads.  Reads do not
+/// modify any shared file position, so readAt() may be called from
+/// multiple threads at once.
+///
+class GLTF_API GLTF_RandomAccessFile
+{
+public:
+    GLTF_RandomAccessFile();
+    ~GLTF_RandomAccessFile();
+
+    GLTF_RandomAccessFile(const GLTF_RandomAccessFile &) = delete;
+    GLTF_RandomAccessFile &operator=(const GLTF_RandomAccessFile &) = delete;
+
+    bool open(const char *filename);
+    void close();
+
+    bool isOpen() const;
+
+    ///
+    /// Reads length bytes starting at offset into dst.
+    /// @return Whether or not all length bytes were read
+    ///
+    bool readAt(exint offset, exint length, unsigned char *dst) const;
+
+private:
+#if defined(WIN32)
+    void *myHandle;
+#else
+    int myFD;
+#endif
+};
+
+} // end GLTF_NAMESPACE
+
+#endif
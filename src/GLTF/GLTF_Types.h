@@ -161,6 +161,21 @@ struct GLTF_API GLTF_NormalTextureInfo : public GLTF_TextureInfo
     // extras
 };
 
+struct GLTF_API GLTF_Sparse
+{
+    // A count of zero means the accessor has no sparse storage
+    GLTF_Int count = 0;
+    // indices
+    GLTF_Handle indicesBufferView = GLTF_INVALID_IDX;
+    GLTF_Int indicesByteOffset = 0;
+    GLTF_ComponentType indicesComponentType = GLTF_COMPONENT_INVALID;
+    // values
+    GLTF_Handle valuesBufferView = GLTF_INVALID_IDX;
+    GLTF_Int valuesByteOffset = 0;
+    // extensions
+    // extras
+};
+
 struct GLTF_API GLTF_Accessor
 {
     GLTF_Handle bufferView = GLTF_INVALID_IDX;
@@ -175,7 +190,7 @@ struct GLTF_API GLTF_Accessor
     UT_Array<fpreal64> max;
     UT_Array<fpreal64> min;
 
-    // sparse
+    GLTF_Sparse sparse;
     UT_String name = "";
     // extensions
     // extras
@@ -190,6 +205,30 @@ struct GLTF_API GLTF_Animation
     // extras
 };
 
+///
+/// Identifies a version of a file on disk
+///
+struct GLTF_API GLTF_FileIdentity
+{
+    int64 mySize = 0;
+    // In nanoseconds where the platform supports it
+    int64 myModTime = 0;
+    // Zero where the platform has no inodes
+    uint64 myInode = 0;
+    // A hash of the ends of the file, or zero if the contents weren't hashed
+    uint64 myHash = 0;
+
+    bool operator==(const GLTF_FileIdentity &other) const
+    {
+        return mySize == other.mySize && myModTime == other.myModTime &&
+               myInode == other.myInode && myHash == other.myHash;
+    }
+    bool operator!=(const GLTF_FileIdentity &other) const
+    {
+        return !(*this == other);
+    }
+};
+
 struct GLTF_API GLTF_Asset
 {
     UT_String copyright = "";
@@ -298,7 +337,7 @@ struct GLTF_API GLTF_Material
     UT_Vector3F emissiveFactor = {0.0f, 0.0f, 0.0f};
     UT_String alphaMode;
     fpreal32 alphaCutoff;
-    bool doubleSided;
+    bool doubleSided = false;
 };
 
 struct GLTF_API GLTF_Primitive
@@ -380,15 +419,6 @@ struct GLTF_API GLTF_Skin
     // extras
 };
 
-struct GLTF_API GLTF_Sparse
-{
-    // count
-    // indices
-    // values
-    // extensions
-    // extras
-};
-
 struct GLTF_API GLTF_Target
 {
     GLTF_Node *node;
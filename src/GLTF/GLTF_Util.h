@@ -29,8 +29,15 @@
 #define __SOP_GLTFUTIL_H__
 
 #include "GLTF_API.h"
+#include "GLTF_Loader.h"
 #include "GLTF_Types.h"
 
+#include <SYS/SYS_Math.h>
+
+#include <limits>
+#include <string.h>
+#include <type_traits>
+
 namespace GLTF_NAMESPACE
 {
 
@@ -47,6 +54,25 @@ public:
     static const char *typeGetName(GLTF_Type type);
     static GLTF_Int componentTypeGetBytes(GLTF_ComponentType type);
     static GLTF_Int typeGetElements(GLTF_Type type);
+
+    ///
+    /// Returns the number of components in each column of a matrix type,
+    /// or the number of components of any other type.
+    ///
+    static GLTF_Int typeGetColumnElements(GLTF_Type type);
+
+    ///
+    /// Returns the distance in bytes between the columns of an element,
+    /// which are padded to 4 bytes for matrices.  Types other than matrices
+    /// have a single column.
+    ///
+    static GLTF_Int
+    getColumnStride(GLTF_Type type, GLTF_ComponentType component_type);
+
+    ///
+    /// Returns the size in bytes of a tightly packed element, including
+    /// the padding of matrix columns.
+    ///
     static GLTF_Int
     getDefaultStride(GLTF_Type type, GLTF_ComponentType component_type);
 
@@ -58,6 +84,31 @@ public:
 
     static GLTF_Type getTypeForTupleSize(uint32 tuplesize);
 
+    ///
+    /// Decodes src_length characters of base64 data from src directly into
+    /// dst, which must hold exactly the dst_length decoded bytes.  Trailing
+    /// padding is optional.
+    /// @return Whether or not the data was valid and of the expected size
+    ///
+    static bool decodeBase64(const char *src, exint src_length,
+                             unsigned char *dst, exint dst_length);
+
+    ///
+    /// Returns the 64 bit FNV-1a hash of size bytes of data, continuing from
+    /// the given hash.
+    ///
+    static uint64 hashBytes(const void *data, exint size,
+                            uint64 hash = 0xcbf29ce484222325ULL);
+
+    ///
+    /// Fills in the identity of the given file.  When hash_contents is set
+    /// the first and last 64KB of the file are hashed, which catches
+    /// rewrites that keep the size and modification time.
+    /// @return Whether or not the file exists
+    ///
+    static bool getFileIdentity(const char *filename, bool hash_contents,
+                                GLTF_FileIdentity &identity);
+
     ///
     /// Returns a list of the scene names in the given filename,
     /// where the index in the returned array corrosponds to the
@@ -71,6 +122,217 @@ public:
                          UT_Quaternion &rotation, UT_Vector3F scale);
 };
 
+///
+/// A typed view of the elements of an accessor.  The view takes care of the
+/// bufferView stride, the accessor's component type and, when T is a floating
+/// point type, the mapping of normalized integers to [0, 1] or [-1, 1].
+/// Each element is read as getTupleSize() values of type T, with matrices in
+/// column major order and without the padding of their columns.
+///
+template <typename T>
+class GLTF_AccessorView
+{
+public:
+    GLTF_AccessorView(const GLTF_Loader &loader, const GLTF_Accessor &accessor)
+        : myData(nullptr)
+        , myStride(0)
+        , myCount(accessor.count)
+        , myTupleSize(GLTF_Util::typeGetElements(accessor.type))
+        , myColumnSize(GLTF_Util::typeGetColumnElements(accessor.type))
+        , myColumnStride(GLTF_Util::getColumnStride(accessor.type,
+                                                    accessor.componentType))
+        , myComponentType(accessor.componentType)
+        , myNormalized(accessor.normalized)
+    {
+        unsigned char *data;
+        uint32 stride;
+        if (myTupleSize > 0 &&
+            loader.LoadAccessorData(accessor, data, stride))
+        {
+            myData = data;
+            myStride = stride;
+        }
+    }
+
+    bool isValid() const { return myData != nullptr; }
+    exint size() const { return myCount; }
+    int getTupleSize() const { return myTupleSize; }
+
+    /// Returns the given component of element idx
+    T get(exint idx, int component = 0) const
+    {
+        T value;
+        switch (myComponentType)
+        {
+        case GLTF_COMPONENT_BYTE:
+            value = convert(load<int8>(idx, component));
+            break;
+        case GLTF_COMPONENT_UNSIGNED_BYTE:
+            value = convert(load<uint8>(idx, component));
+            break;
+        case GLTF_COMPONENT_SHORT:
+            value = convert(load<int16>(idx, component));
+            break;
+        case GLTF_COMPONENT_UNSIGNED_SHORT:
+            value = convert(load<uint16>(idx, component));
+            break;
+        case GLTF_COMPONENT_UNSIGNED_INT:
+            value = convert(load<uint32>(idx, component));
+            break;
+        case GLTF_COMPONENT_FLOAT:
+            value = convert(load<fpreal32>(idx, component));
+            break;
+        default:
+            value = T(0);
+            break;
+        }
+        return value;
+    }
+
+    ///
+    /// Copies count elements starting at element start into dst, which
+    /// receives getTupleSize() tightly packed values per element.
+    ///
+    void copyTo(exint start, exint count, T *dst) const
+    {
+        UT_ASSERT(isValid() && start >= 0 && start + count <= myCount);
+        switch (myComponentType)
+        {
+        case GLTF_COMPONENT_BYTE:
+            copyElements<int8>(start, count, dst);
+            break;
+        case GLTF_COMPONENT_UNSIGNED_BYTE:
+            copyElements<uint8>(start, count, dst);
+            break;
+        case GLTF_COMPONENT_SHORT:
+            copyElements<int16>(start, count, dst);
+            break;
+        case GLTF_COMPONENT_UNSIGNED_SHORT:
+            copyElements<uint16>(start, count, dst);
+            break;
+        case GLTF_COMPONENT_UNSIGNED_INT:
+            copyElements<uint32>(start, count, dst);
+            break;
+        case GLTF_COMPONENT_FLOAT:
+            copyElements<fpreal32>(start, count, dst);
+            break;
+        default:
+            UT_ASSERT(false);
+            break;
+        }
+    }
+
+    /// Copies every element into dst, resizing it as needed
+    bool copyTo(UT_Array<T> &dst) const
+    {
+        if (!isValid())
+            return false;
+        dst.setSizeNoInit(myCount * myTupleSize);
+        copyTo(0, myCount, dst.data());
+        return true;
+    }
+
+private:
+    template <typename S>
+    S load(exint idx, int component) const
+    {
+        // Accessor data is only guaranteed to be aligned to the component
+        // size by well formed files, so don't rely on it.
+        S value;
+        memcpy(&value,
+               myData + idx * myStride +
+                   (component / myColumnSize) * myColumnStride +
+                   (component % myColumnSize) * sizeof(S),
+               sizeof(S));
+        return value;
+    }
+
+    template <typename S>
+    T convert(S value) const
+    {
+        if (std::is_floating_point<T>::value && !std::is_same<S, fpreal32>::value
+            && myNormalized)
+        {
+            return T(normalize(value));
+        }
+        return T(value);
+    }
+
+    template <typename S>
+    static fpreal32 normalize(S value)
+    {
+        const fpreal32 result =
+            fpreal32(value) / fpreal32(std::numeric_limits<S>::max());
+        return std::is_signed<S>::value ? SYSmax(result, -1.0F) : result;
+    }
+
+    template <typename S, bool NORMALIZE>
+    static void convertRange(const unsigned char *src, exint n, T *dst)
+    {
+        for (exint i = 0; i < n; ++i)
+        {
+            S value;
+            memcpy(&value, src + i * sizeof(S), sizeof(S));
+            dst[i] = NORMALIZE ? T(normalize(value)) : T(value);
+        }
+    }
+
+    template <typename S, bool NORMALIZE>
+    void copyKernel(exint start, exint count, T *dst) const
+    {
+        const exint tuple_size = myTupleSize;
+        const exint column_size = myColumnSize;
+        const unsigned char *src = myData + start * myStride;
+
+        // Tightly packed data is one long run of components, which lets the
+        // compiler vectorize the conversion
+        if (myStride == sizeof(S) * tuple_size &&
+            myColumnStride == sizeof(S) * column_size)
+        {
+            if (std::is_same<S, T>::value)
+                memcpy(dst, src, count * tuple_size * sizeof(T));
+            else
+                convertRange<S, NORMALIZE>(src, count * tuple_size, dst);
+            return;
+        }
+
+        // Padded matrix columns are converted one column at a time
+        for (exint i = 0; i < count; ++i)
+        {
+            for (exint c = 0; c < tuple_size; c += column_size)
+            {
+                convertRange<S, NORMALIZE>(
+                    src + (c / column_size) * myColumnStride, column_size,
+                    dst + c);
+            }
+            src += myStride;
+            dst += tuple_size;
+        }
+    }
+
+    template <typename S>
+    void copyElements(exint start, exint count, T *dst) const
+    {
+        if (std::is_floating_point<T>::value &&
+            !std::is_floating_point<S>::value && myNormalized)
+        {
+            copyKernel<S, true>(start, count, dst);
+        }
+        else
+            copyKernel<S, false>(start, count, dst);
+    }
+
+    const unsigned char *myData;
+    exint myStride;
+    exint myCount;
+    int myTupleSize;
+    // The components in each column, and the bytes between columns
+    int myColumnSize;
+    exint myColumnStride;
+    GLTF_ComponentType myComponentType;
+    bool myNormalized;
+};
+
 } // end GLTF_NAMESPACE
 
 #endif
@@ -29,10 +29,13 @@
 #define __SOP_GLTF_H__
 
 #include <GLTF/GLTF_Types.h>
+#include <GU/GU_DetailHandle.h>
 #include <SOP/SOP_Node.h>
 #include <UT/UT_Array.h>
 #include <UT/UT_Interrupt.h>
+#include <UT/UT_Map.h>
 #include <UT/UT_Pair.h>
+#include <UT/UT_StringHolder.h>
 
 #include <GLTF/GLTF_Loader.h>
 #include <GLTF/GLTF_GeoLoader.h>
@@ -51,7 +54,8 @@ enum GLTF_LoadStyle
 enum GLTF_GeoType
 {
     Houdini_Geo,
-    Packed_Primitives
+    Packed_Primitives,
+    Delayed_Packed_Primitives
 };
 
 typedef GLTF_NAMESPACE::GLTF_Int        GLTF_Int;
@@ -108,6 +112,8 @@ private:
         uint32 myLoadMats;
         uint32 myPromotePointAttrsToVertex;
         fpreal myPointConsolidationDistance;
+        GLTF_NAMESPACE::GLTF_PointWeldMode myPointWeldMode;
+        uint32 myCompactStorage;
     };
 
     void evaluateParms(Parms &parms, OP_Context &context);
@@ -133,6 +139,11 @@ public:
         bool promotePointAttribs = true;
         bool consolidateByMesh = true;
         fpreal pointConsolidationDistance = 0.0001F;
+        GLTF_NAMESPACE::GLTF_PointWeldMode pointWeldMode =
+            GLTF_NAMESPACE::GLTF_POINT_WELD_DISTANCE;
+        bool compactStorage = false;
+        // Creates packed primitives that load their geometry on demand
+        bool delayLoad = false;
     };
 
     SOP_GLTF_Loader(const GLTF_NAMESPACE::GLTF_Loader &loader, GU_Detail *detail,
@@ -144,19 +155,55 @@ public:
     bool loadPrimitive(GLTF_Handle node_idx, GLTF_Handle prim_idx);
 
 private:
+    // A primitive of a mesh instanced by a node, with the world transform
+    // of the node
+    struct PrimitiveItem
+    {
+        GLTF_Handle myMeshIdx;
+        GLTF_Handle myPrimIdx;
+        UT_Matrix4F myXform;
+        UT_StringHolder myMaterialPath;
+        GU_DetailHandle myDetail;
+    };
+
     void getMaterialPath(GLTF_Int index, UT_String &path);
 
+    // Appends every primitive under the node, in hierarchy order
+    void collectPrimitives(const GLTF_Node &node, UT_Matrix4F cum_xform,
+                           UT_Array<PrimitiveItem> &items);
+
+    // Converts the primitives of the items in parallel, and sets the
+    // detail of each item to its converted primitive.  Returns false if
+    // the conversion was interrupted.
+    bool loadPrimitives(UT_Array<PrimitiveItem> &items);
+
+    // Writes every item, transformed, into a single allocation of myDetail.
+    // Returns false if the merge was interrupted.
+    bool mergeFlattened(UT_Array<PrimitiveItem> &items);
+
     // Puts the current node in parent_gd as a packed primitive
     // with the name as well as transforms
-    void loadNodeRecursive(const GLTF_Node &node, GU_Detail *parent_gd,
-                           UT_Matrix4F cum_xform);
+    void loadNodeRecursive(const GLTF_Node &node, GU_Detail *parent_gd);
 
     void createAndSetName(GU_Detail *detail, const char *name) const;
     GLTF_NAMESPACE::GLTF_MeshLoadingOptions getGeoOptions() const;
 
+    // Returns the converted primitive, which is loaded only once for all
+    // of the nodes referencing its mesh
+    GU_DetailHandle loadSharedPrimitive(GLTF_Handle mesh_idx,
+                                        GLTF_Handle prim_idx);
+
+    static uint64 primitiveKey(GLTF_Handle mesh_idx, GLTF_Handle prim_idx)
+    {
+        return (uint64(mesh_idx) << 32) | prim_idx;
+    }
+
     const GLTF_NAMESPACE::GLTF_Loader &myLoader;
     GU_Detail *myDetail;
     const Options myOptions;
+
+    // The converted primitives of this load, keyed by mesh and primitive
+    UT_Map<uint64, GU_DetailHandle> myPrimitives;
 };
 
 #endif